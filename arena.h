@@ -0,0 +1,170 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdlib>
+
+using namespace std;
+
+#ifdef ARENA_COUNT_HEAP
+// Counts every global operator new so --stats can show heap traffic.
+// Like the rest of these headers, include from a single translation unit.
+size_t heapAllocations = 0;
+
+// noinline keeps GCC from seeing malloc()/free() behind new/delete and
+// warning about mismatched pairs.
+__attribute__((noinline)) void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+#endif
+
+struct ArenaStats {
+    size_t allocations; // requests served
+    size_t bytes;       // bytes handed out
+    size_t chunks;      // chunks taken from the global heap
+    size_t resets;
+    ArenaStats() : allocations(0), bytes(0), chunks(0), resets(0) {}
+};
+
+// Monotonic arena: hands out memory from large chunks, never frees single
+// allocations. reset() rewinds to the first chunk and keeps every chunk, so
+// a workload that repeats (one query after another) stops touching the
+// global heap after its first run. release() returns the chunks.
+class Arena {
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    vector<Chunk> chunks;
+    size_t current;
+    size_t offset;
+    size_t chunkSize;
+    ArenaStats stats;
+
+public:
+    explicit Arena(size_t chunkSize = 64 * 1024) : current(0), offset(0), chunkSize(chunkSize) {}
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        stats.allocations++;
+        stats.bytes += bytes;
+
+        // Chunks come from operator new, so they are aligned for any
+        // fundamental type; only the offset inside a chunk needs rounding.
+        while (current < chunks.size()) {
+            size_t start = (offset + align - 1) & ~(align - 1);
+            if (start + bytes <= chunks[current].size) {
+                offset = start + bytes;
+                return chunks[current].data + start;
+            }
+            current++;
+            offset = 0;
+        }
+
+        Chunk chunk;
+        chunk.size = max(chunkSize, bytes);
+        chunk.data = static_cast<char*>(::operator new(chunk.size));
+        chunks.push_back(chunk);
+        stats.chunks++;
+        current = chunks.size() - 1;
+        offset = bytes;
+        return chunk.data;
+    }
+
+    void reset() {
+        current = 0;
+        offset = 0;
+        stats.resets++;
+    }
+
+    void release() {
+        for (const Chunk& c : chunks) ::operator delete(c.data);
+        chunks.clear();
+        current = 0;
+        offset = 0;
+    }
+
+    size_t reservedBytes() const {
+        size_t total = 0;
+        for (const Chunk& c : chunks) total += c.size;
+        return total;
+    }
+
+    const ArenaStats& getStats() const { return stats; }
+
+    void printStats(const string& name) const {
+        cout << "  " << name << ": " << stats.allocations << " allocations, "
+             << stats.bytes / 1024 << " KiB served from " << stats.chunks << " chunks ("
+             << reservedBytes() / 1024 << " KiB held)";
+        if (stats.resets) cout << ", " << stats.resets << " resets";
+        cout << endl;
+    }
+};
+
+// Standard allocator over an Arena. A null arena falls back to the global
+// heap, so containers using it stay default-constructible. Copies of a
+// container go to the global heap too: a copy is how a result is kept past
+// the arena's next reset(), so it must not share the arena. Moves keep it.
+template <class T>
+struct ArenaAllocator {
+    typedef T value_type;
+    Arena* arena;
+
+    ArenaAllocator(Arena* arena = nullptr) noexcept : arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    T* allocate(size_t n) {
+        if (!arena) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        if (!arena) ::operator delete(p);
+    }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <class T>
+using ArenaVector = vector<T, ArenaAllocator<T>>;
+
+void printHeapStats(size_t loadAllocations, size_t queryAllocations) {
+#ifdef ARENA_COUNT_HEAP
+    cout << "  global heap: " << loadAllocations << " allocations while loading, "
+         << queryAllocations << " while querying" << endl;
+#else
+    (void)loadAllocations;
+    (void)queryAllocations;
+    cout << "  global heap: not counted (build with -DARENA_COUNT_HEAP)" << endl;
+#endif
+}
+
+size_t heapAllocationCount() {
+#ifdef ARENA_COUNT_HEAP
+    return heapAllocations;
+#else
+    return 0;
+#endif
+}
+
+#endif // ARENA_H
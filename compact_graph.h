@@ -0,0 +1,181 @@
+#ifndef COMPACT_GRAPH_H
+#define COMPACT_GRAPH_H
+
+#include "graph_loader.h"
+#include <cstdint>
+#include <stdexcept>
+
+// Mode codes packed into the low bits of CompactGraph edge targets.
+enum Mode : uint8_t { MODE_ROAD, MODE_METRO, MODE_BIKOLPO, MODE_UTTARA, MODE_COUNT };
+
+const int MODE_BITS = 3;
+const uint32_t MODE_MASK = (1u << MODE_BITS) - 1;
+const size_t MAX_COMPACT_NODES = size_t(1) << (32 - MODE_BITS); // node ids left in a packed edge
+static_assert(MODE_COUNT <= MODE_MASK + 1, "modes must fit in MODE_BITS");
+const double COORD_SCALE = 1e6; // fixed-point units per degree (datasets use 6 decimals)
+
+// Edge type strings of the full graph, indexed by Mode.
+const char* const MODE_TYPES[MODE_COUNT] = {"road", "metro", "bikolpo", "uttara"};
+
+// Throws on a type with no Mode rather than pricing it as some other mode.
+Mode modeFromType(const string& type) {
+    for (int m = 0; m < MODE_COUNT; m++) {
+        if (type == MODE_TYPES[m]) return (Mode)m;
+    }
+    throw invalid_argument("no compact mode for edge type \"" + type + "\"");
+}
+
+// Per-mode rate array for CompactGraph::solve from a solver's cost table;
+// modes missing from the table get -1 (not used).
+void ratesFromCostTable(const map<string, double>& costPerKm, double rates[MODE_COUNT]) {
+    fill(rates, rates + MODE_COUNT, -1.0);
+    for (const auto& entry : costPerKm) rates[modeFromType(entry.first)] = entry.second;
+}
+
+// Result of CompactGraph::solve; modes[i] is the mode of hop i -> i + 1 and
+// distances[i] its length in km. path is empty if there is no route.
+struct CompactRoute {
+    vector<int> path;
+    vector<Mode> modes;
+    vector<float> distances;
+    double cost;
+};
+
+// Read-only, low-memory copy of a loaded graph for running many routing
+// replicas per host:
+//   - coordinates as int32 fixed point (1e-6 degree, ~0.1 m), stored as
+//     separate lon/lat arrays;
+//   - adjacency in CSR form, each edge 8 bytes: uint32 (to << 3 | mode,
+//     so fewer than 2^29 nodes; the constructor throws otherwise)
+//     plus a float distance in km.
+// Edge distances are the loader's doubles rounded to float (relative error
+// <= 2^-24 per edge) and path costs are summed in double, so route costs
+// agree with the full graph to within 1e-6 relative; paths are identical
+// unless two routes tie within that tolerance.
+class CompactGraph {
+private:
+    vector<int32_t> lons, lats;
+    vector<uint32_t> offsets; // edges of node i: [offsets[i], offsets[i + 1])
+    vector<uint32_t> targets; // to << MODE_BITS | mode
+    vector<float> weights;
+
+    struct QueueItem {
+        int node;
+        double cost;
+        QueueItem(int n, double c) : node(n), cost(c) {}
+        bool operator>(const QueueItem& other) const { return cost > other.cost; }
+    };
+
+public:
+    explicit CompactGraph(const GraphLoader& graph) {
+        const vector<Node>& nodes = graph.getNodes();
+        size_t edgeCount = 0;
+        for (const Node& n : nodes) edgeCount += n.edges.size();
+        if (nodes.size() >= MAX_COMPACT_NODES || edgeCount > UINT32_MAX) {
+            throw length_error("graph too large for CompactGraph's 32-bit packed edges");
+        }
+
+        lons.reserve(nodes.size());
+        lats.reserve(nodes.size());
+        offsets.reserve(nodes.size() + 1);
+        targets.reserve(edgeCount);
+        weights.reserve(edgeCount);
+
+        offsets.push_back(0);
+        for (const Node& n : nodes) {
+            lons.push_back((int32_t)llround(n.location.lon * COORD_SCALE));
+            lats.push_back((int32_t)llround(n.location.lat * COORD_SCALE));
+            for (const Edge& e : n.edges) {
+                targets.push_back((uint32_t)e.to << MODE_BITS | modeFromType(e.type));
+                weights.push_back((float)e.distance);
+            }
+            offsets.push_back((uint32_t)targets.size());
+        }
+    }
+
+    size_t getNodeCount() const { return lons.size(); }
+    size_t getEdgeCount() const { return targets.size(); }
+
+    Point location(int node) const {
+        return Point(lons[node] / COORD_SCALE, lats[node] / COORD_SCALE);
+    }
+
+    int findNearestNode(const Point& p) const {
+        return nearestPoint(p, lons.size(), [this](size_t i) { return location(i); });
+    }
+
+    // Cheapest path where costPerKm[mode] is the rate per km; modes with a
+    // negative rate are not used. Same path and cost as ProblemNSolver::solve,
+    // plus the mode and length of each hop from the packed edges.
+    CompactRoute solve(int start, int end, const double costPerKm[MODE_COUNT]) const {
+        vector<double> dist(lons.size(), INF);
+        vector<int> parent(lons.size(), -1);
+        vector<uint32_t> parentEdge(lons.size(), 0);
+        priority_queue<QueueItem, vector<QueueItem>, greater<QueueItem>> pq;
+
+        dist[start] = 0;
+        pq.push(QueueItem(start, 0));
+
+        while (!pq.empty()) {
+            QueueItem current = pq.top();
+            pq.pop();
+
+            if (current.node == end) break;
+            if (current.cost > dist[current.node]) continue;
+
+            for (uint32_t i = offsets[current.node]; i < offsets[current.node + 1]; i++) {
+                double rate = costPerKm[targets[i] & MODE_MASK];
+                if (rate < 0) continue;
+
+                int to = targets[i] >> MODE_BITS;
+                double newCost = dist[current.node] + weights[i] * rate;
+                if (newCost < dist[to]) {
+                    dist[to] = newCost;
+                    parent[to] = current.node;
+                    parentEdge[to] = i;
+                    pq.push(QueueItem(to, newCost));
+                }
+            }
+        }
+
+        CompactRoute route;
+        route.cost = dist[end];
+        if (dist[end] < INF) {
+            for (int curr = end; curr != -1; curr = parent[curr]) {
+                route.path.push_back(curr);
+                if (parent[curr] != -1) {
+                    route.modes.push_back((Mode)(targets[parentEdge[curr]] & MODE_MASK));
+                    route.distances.push_back(weights[parentEdge[curr]]);
+                }
+            }
+            reverse(route.path.begin(), route.path.end());
+            reverse(route.modes.begin(), route.modes.end());
+            reverse(route.distances.begin(), route.distances.end());
+        }
+        return route;
+    }
+
+    size_t nodeBytes() const {
+        return (lons.capacity() + lats.capacity()) * sizeof(int32_t) +
+               offsets.capacity() * sizeof(uint32_t);
+    }
+
+    size_t edgeBytes() const {
+        return targets.capacity() * sizeof(uint32_t) + weights.capacity() * sizeof(float);
+    }
+
+    void printMemoryReport(const GraphLoader& full) const {
+        double n = getNodeCount(), m = getEdgeCount();
+        cout << fixed << setprecision(1);
+        cout << "Memory (full):    " << full.nodeBytes() / n << " bytes/node, "
+             << full.edgeBytes() / m << " bytes/edge, "
+             << (full.nodeBytes() + full.edgeBytes()) / 1024.0 << " KiB total" << endl;
+        cout << "Memory (compact): " << nodeBytes() / n << " bytes/node, "
+             << edgeBytes() / m << " bytes/edge, "
+             << (nodeBytes() + edgeBytes()) / 1024.0 << " KiB total" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+
+#endif // COMPACT_GRAPH_H
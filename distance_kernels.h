@@ -0,0 +1,231 @@
+#ifndef DISTANCE_KERNELS_H
+#define DISTANCE_KERNELS_H
+
+#include "graph_utils.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DISTANCE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Batched haversine over structure-of-arrays coordinates (degrees).
+//
+// haversineKernel() fills out[i] for the pair (lon1[i], lat1[i]) ->
+// (lon2[i], lat2[i]) with either the haversine term
+//   a = sin^2(dlat / 2) + cos(lat1) cos(lat2) sin^2(dlon / 2)
+// (monotone in distance, enough for nearest-point scans) or the distance
+// in km. The AVX2+FMA or SSE2 version is picked at runtime, with a scalar
+// fallback elsewhere.
+//
+// Accuracy against haversineDistance(): sin/cos use a degree-19 odd Taylor
+// polynomial on [0, pi/2] (truncation < 3e-16) and asin a degree-15 series
+// used only while sqrt(a) <= 0.1, i.e. below ~1270 km (truncation < 2e-17
+// relative); longer pairs use libm asin. Results agree with the scalar
+// version to within 1e-13 relative plus 1e-12 km, which is far below the
+// 1e-6 degree resolution of the datasets.
+
+const int KERNEL_BLOCK = 256; // SoA block size used by the batch helpers
+
+namespace kernel_detail {
+
+const double DEG_TO_RAD = M_PI / 180.0;
+const double ASIN_SERIES_LIMIT = 0.1;
+
+const double SIN_COEFFS[10] = {
+    1.0, -0.16666666666666666, 0.008333333333333333, -0.0001984126984126984,
+    2.7557319223985893e-06, -2.505210838544172e-08, 1.6059043836821613e-10,
+    -7.647163731819816e-13, 2.8114572543455206e-15, -8.22063524662433e-18};
+
+const double ASIN_COEFFS[8] = {
+    1.0, 0.16666666666666666, 0.075, 0.044642857142857144,
+    0.030381944444444444, 0.022372159090909092, 0.017352764423076924, 0.01396484375};
+
+// Reference for one pair, also used for tails shorter than a vector.
+inline double scalarTerm(double lon1, double lat1, double lon2, double lat2, bool distance) {
+    double sdlat = sin((lat2 - lat1) * DEG_TO_RAD / 2);
+    double sdlon = sin((lon2 - lon1) * DEG_TO_RAD / 2);
+    double a = sdlat * sdlat + cos(lat1 * DEG_TO_RAD) * cos(lat2 * DEG_TO_RAD) * sdlon * sdlon;
+    if (!distance) return a;
+    return EARTH_RADIUS * 2 * asin(sqrt(min(a, 1.0)));
+}
+
+inline void scalarKernel(const double* lon1, const double* lat1, const double* lon2,
+                         const double* lat2, double* out, size_t n, bool distance) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = scalarTerm(lon1[i], lat1[i], lon2[i], lat2[i], distance);
+    }
+}
+
+#ifdef DISTANCE_KERNELS_X86
+
+// sin(x) for |x| <= pi, evaluated as sign(x) * P(y) with y = |x| folded
+// into [0, pi/2].
+__attribute__((target("avx2,fma"))) inline __m256d sinAVX2(__m256d x) {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d pi = _mm256_set1_pd(M_PI);
+    const __m256d halfPi = _mm256_set1_pd(M_PI / 2);
+    __m256d sign = _mm256_and_pd(x, signMask);
+    __m256d y = _mm256_andnot_pd(signMask, x);
+    y = _mm256_blendv_pd(y, _mm256_sub_pd(pi, y), _mm256_cmp_pd(y, halfPi, _CMP_GT_OQ));
+    __m256d y2 = _mm256_mul_pd(y, y);
+    __m256d p = _mm256_set1_pd(SIN_COEFFS[9]);
+    for (int k = 8; k >= 0; k--) p = _mm256_fmadd_pd(p, y2, _mm256_set1_pd(SIN_COEFFS[k]));
+    return _mm256_or_pd(_mm256_mul_pd(p, y), sign);
+}
+
+__attribute__((target("avx2,fma"))) inline void avx2Kernel(
+    const double* lon1, const double* lat1, const double* lon2, const double* lat2,
+    double* out, size_t n, bool distance) {
+    const __m256d toRad = _mm256_set1_pd(DEG_TO_RAD);
+    const __m256d halfToRad = _mm256_set1_pd(DEG_TO_RAD / 2);
+    const __m256d halfPi = _mm256_set1_pd(M_PI / 2);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d limit = _mm256_set1_pd(ASIN_SERIES_LIMIT);
+    const __m256d scale = _mm256_set1_pd(2 * EARTH_RADIUS);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d la1 = _mm256_loadu_pd(lat1 + i), la2 = _mm256_loadu_pd(lat2 + i);
+        __m256d dlat = _mm256_mul_pd(_mm256_sub_pd(la2, la1), halfToRad);
+        __m256d dlon = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(lon2 + i),
+                                                   _mm256_loadu_pd(lon1 + i)), halfToRad);
+        // cos(lat) = sin(pi/2 - |lat|)
+        __m256d c1 = sinAVX2(_mm256_sub_pd(halfPi, _mm256_andnot_pd(signMask, _mm256_mul_pd(la1, toRad))));
+        __m256d c2 = sinAVX2(_mm256_sub_pd(halfPi, _mm256_andnot_pd(signMask, _mm256_mul_pd(la2, toRad))));
+        __m256d sdlat = sinAVX2(dlat), sdlon = sinAVX2(dlon);
+        __m256d a = _mm256_fmadd_pd(_mm256_mul_pd(c1, c2), _mm256_mul_pd(sdlon, sdlon),
+                                    _mm256_mul_pd(sdlat, sdlat));
+        if (!distance) {
+            _mm256_storeu_pd(out + i, a);
+            continue;
+        }
+
+        __m256d s = _mm256_sqrt_pd(a);
+        __m256d s2 = _mm256_mul_pd(s, s);
+        __m256d p = _mm256_set1_pd(ASIN_COEFFS[7]);
+        for (int k = 6; k >= 0; k--) p = _mm256_fmadd_pd(p, s2, _mm256_set1_pd(ASIN_COEFFS[k]));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(scale, _mm256_mul_pd(p, s)));
+
+        int far = _mm256_movemask_pd(_mm256_cmp_pd(s, limit, _CMP_GT_OQ));
+        for (int lane = 0; far; lane++, far >>= 1) {
+            if (far & 1) out[i + lane] = scalarTerm(lon1[i + lane], lat1[i + lane],
+                                                    lon2[i + lane], lat2[i + lane], true);
+        }
+    }
+    scalarKernel(lon1 + i, lat1 + i, lon2 + i, lat2 + i, out + i, n - i, distance);
+}
+
+__attribute__((target("sse2"))) inline __m128d sinSSE2(__m128d x) {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d pi = _mm_set1_pd(M_PI);
+    const __m128d halfPi = _mm_set1_pd(M_PI / 2);
+    __m128d sign = _mm_and_pd(x, signMask);
+    __m128d y = _mm_andnot_pd(signMask, x);
+    __m128d folded = _mm_cmpgt_pd(y, halfPi);
+    y = _mm_or_pd(_mm_and_pd(folded, _mm_sub_pd(pi, y)), _mm_andnot_pd(folded, y));
+    __m128d y2 = _mm_mul_pd(y, y);
+    __m128d p = _mm_set1_pd(SIN_COEFFS[9]);
+    for (int k = 8; k >= 0; k--) p = _mm_add_pd(_mm_mul_pd(p, y2), _mm_set1_pd(SIN_COEFFS[k]));
+    return _mm_or_pd(_mm_mul_pd(p, y), sign);
+}
+
+__attribute__((target("sse2"))) inline void sse2Kernel(
+    const double* lon1, const double* lat1, const double* lon2, const double* lat2,
+    double* out, size_t n, bool distance) {
+    const __m128d toRad = _mm_set1_pd(DEG_TO_RAD);
+    const __m128d halfToRad = _mm_set1_pd(DEG_TO_RAD / 2);
+    const __m128d halfPi = _mm_set1_pd(M_PI / 2);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d limit = _mm_set1_pd(ASIN_SERIES_LIMIT);
+    const __m128d scale = _mm_set1_pd(2 * EARTH_RADIUS);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d la1 = _mm_loadu_pd(lat1 + i), la2 = _mm_loadu_pd(lat2 + i);
+        __m128d dlat = _mm_mul_pd(_mm_sub_pd(la2, la1), halfToRad);
+        __m128d dlon = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(lon2 + i), _mm_loadu_pd(lon1 + i)), halfToRad);
+        __m128d c1 = sinSSE2(_mm_sub_pd(halfPi, _mm_andnot_pd(signMask, _mm_mul_pd(la1, toRad))));
+        __m128d c2 = sinSSE2(_mm_sub_pd(halfPi, _mm_andnot_pd(signMask, _mm_mul_pd(la2, toRad))));
+        __m128d sdlat = sinSSE2(dlat), sdlon = sinSSE2(dlon);
+        __m128d a = _mm_add_pd(_mm_mul_pd(sdlat, sdlat),
+                               _mm_mul_pd(_mm_mul_pd(c1, c2), _mm_mul_pd(sdlon, sdlon)));
+        if (!distance) {
+            _mm_storeu_pd(out + i, a);
+            continue;
+        }
+
+        __m128d s = _mm_sqrt_pd(a);
+        __m128d s2 = _mm_mul_pd(s, s);
+        __m128d p = _mm_set1_pd(ASIN_COEFFS[7]);
+        for (int k = 6; k >= 0; k--) p = _mm_add_pd(_mm_mul_pd(p, s2), _mm_set1_pd(ASIN_COEFFS[k]));
+        _mm_storeu_pd(out + i, _mm_mul_pd(scale, _mm_mul_pd(p, s)));
+
+        int far = _mm_movemask_pd(_mm_cmpgt_pd(s, limit));
+        for (int lane = 0; far; lane++, far >>= 1) {
+            if (far & 1) out[i + lane] = scalarTerm(lon1[i + lane], lat1[i + lane],
+                                                    lon2[i + lane], lat2[i + lane], true);
+        }
+    }
+    scalarKernel(lon1 + i, lat1 + i, lon2 + i, lat2 + i, out + i, n - i, distance);
+}
+
+#endif // DISTANCE_KERNELS_X86
+
+typedef void (*KernelFn)(const double*, const double*, const double*, const double*,
+                         double*, size_t, bool);
+
+inline KernelFn selectKernel() {
+#ifdef DISTANCE_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return avx2Kernel;
+    if (__builtin_cpu_supports("sse2")) return sse2Kernel;
+#endif
+    return scalarKernel;
+}
+
+} // namespace kernel_detail
+
+inline void haversineKernel(const double* lon1, const double* lat1, const double* lon2,
+                            const double* lat2, double* out, size_t n, bool distance) {
+    static const kernel_detail::KernelFn kernel = kernel_detail::selectKernel();
+    kernel(lon1, lat1, lon2, lat2, out, n, distance);
+}
+
+// Distances in km for n coordinate pairs; same contract as haversineDistance.
+inline void haversineBatch(const double* lon1, const double* lat1, const double* lon2,
+                           const double* lat2, double* out, size_t n) {
+    haversineKernel(lon1, lat1, lon2, lat2, out, n, true);
+}
+
+// Index of the closest of n points to p, or -1 when n == 0. locate(i)
+// returns point i; points are decoded KERNEL_BLOCK at a time into SoA
+// buffers, so callers keep no SoA copy of their coordinates. Compares
+// haversine terms, so ties resolve to the lowest index like the scalar loops.
+template <class Locate>
+int nearestPoint(const Point& p, size_t n, Locate locate) {
+    double qLon[KERNEL_BLOCK], qLat[KERNEL_BLOCK];
+    double bLon[KERNEL_BLOCK], bLat[KERNEL_BLOCK], terms[KERNEL_BLOCK];
+    fill(qLon, qLon + KERNEL_BLOCK, p.lon);
+    fill(qLat, qLat + KERNEL_BLOCK, p.lat);
+
+    int nearest = -1;
+    double minTerm = INF;
+    for (size_t base = 0; base < n; base += KERNEL_BLOCK) {
+        size_t count = min((size_t)KERNEL_BLOCK, n - base);
+        for (size_t i = 0; i < count; i++) {
+            Point q = locate(base + i);
+            bLon[i] = q.lon;
+            bLat[i] = q.lat;
+        }
+        haversineKernel(qLon, qLat, bLon, bLat, terms, count, false);
+        for (size_t i = 0; i < count; i++) {
+            if (terms[i] < minTerm) {
+                minTerm = terms[i];
+                nearest = base + i;
+            }
+        }
+    }
+    return nearest;
+}
+
+#endif // DISTANCE_KERNELS_H
@@ -1,22 +1,68 @@
 #ifndef GRAPH_LOADER_H
 #define GRAPH_LOADER_H
 
-#include "graph_utils.h"
+#include "distance_kernels.h"
+
+// Allocation-free stand-in for the istringstream reads the loaders use
+// (libstdc++ allocates a buffer for every double extracted from a stream).
+// Mirrors stream semantics: a failed read sticks, a read at end of line
+// leaves the value untouched, a read of non-numeric text stores 0.
+class LineCursor {
+private:
+    const char* p;
+    bool failed;
+
+public:
+    explicit LineCursor(const string& line) : p(line.c_str()), failed(false) {}
+    
+    // Skips past the next ',' like getline(ss, field, ',').
+    void skipField() {
+        while (*p && *p != ',') p++;
+        if (*p) p++;
+    }
+    
+    LineCursor& operator>>(double& value) {
+        if (failed) return *this;
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p) {
+            failed = true;
+            return *this;
+        }
+        char* end;
+        value = strtod(p, &end);
+        if (end == p) failed = true;
+        p = end;
+        return *this;
+    }
+    
+    explicit operator bool() const { return !failed; }
+    int peek() const { return failed || !*p ? EOF : (unsigned char)*p; }
+    void ignore(int count = 1, char = 0) {
+        while (!failed && *p && count-- > 0) p++;
+    }
+};
+
+typedef map<pair<double, double>, int, less<pair<double, double>>,
+            ArenaAllocator<pair<const pair<double, double>, int>>> PointLookup;
 
 class GraphLoader {
 private:
+    // Declared first so they outlive the containers they back.
+    Arena edgeArena;    // per-node edge lists, lives as long as the graph
+    Arena lookupArena;  // pointToNode entries, freed by releaseLookup()
+    Arena scratchArena; // per-file segment batches, rewound for every file
+    
     vector<Node> nodes;
-    map<pair<double, double>, int> pointToNode;
+    PointLookup pointToNode;
     
     int getOrCreateNode(const Point& p) {
         auto key = make_pair(p.lon, p.lat);
-        if (pointToNode.find(key) != pointToNode.end()) {
-            return pointToNode[key];
+        auto it = pointToNode.find(key);
+        if (it != pointToNode.end()) {
+            return it->second;
         }
         int idx = nodes.size();
-        Node node;
-        node.location = p;
-        nodes.push_back(node);
+        nodes.push_back(Node(p, &edgeArena));
         pointToNode[key] = idx;
         return idx;
     }
@@ -28,18 +74,63 @@ private:
         }
     }
     
+    // Segments of one file, collected so their lengths can be computed in
+    // a single haversineBatch call before the edges are added.
+    struct SegmentBatch {
+        ArenaVector<int> from, to;
+        ArenaVector<double> lon1, lat1, lon2, lat2;
+        
+        explicit SegmentBatch(Arena* arena)
+            : from(arena), to(arena), lon1(arena), lat1(arena), lon2(arena), lat2(arena) {}
+        
+        void add(int n1, int n2, const Point& p1, const Point& p2) {
+            from.push_back(n1);
+            to.push_back(n2);
+            lon1.push_back(p1.lon);
+            lat1.push_back(p1.lat);
+            lon2.push_back(p2.lon);
+            lat2.push_back(p2.lat);
+        }
+    };
+    
+    void addSegments(const SegmentBatch& batch, const string& type) {
+        ArenaVector<double> dist(batch.from.size(), 0.0, &scratchArena);
+        haversineBatch(batch.lon1.data(), batch.lat1.data(), batch.lon2.data(),
+                       batch.lat2.data(), dist.data(), dist.size());
+        
+        // Size each edge list once per file: regrowing inside the edge arena
+        // would leave every outgrown buffer behind.
+        ArenaVector<int> added(nodes.size(), 0, &scratchArena);
+        for (size_t i = 0; i < dist.size(); i++) {
+            if (batch.from[i] != batch.to[i]) {
+                added[batch.from[i]]++;
+                added[batch.to[i]]++;
+            }
+        }
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (added[n]) nodes[n].edges.reserve(nodes[n].edges.size() + added[n]);
+        }
+        for (size_t i = 0; i < dist.size(); i++) {
+            addEdge(batch.from[i], batch.to[i], dist[i], type);
+        }
+    }
+    
 public:
+    GraphLoader() : pointToNode(PointLookup::key_compare(), &lookupArena) {}
+    
     void loadRoadmap(const string& filename) {
         ifstream file(filename);
         string line;
+        vector<Point> points;
+        scratchArena.reset();
+        SegmentBatch batch(&scratchArena);
         
         while (getline(file, line)) {
-            stringstream ss(line);
-            string type;
-            getline(ss, type, ',');
+            LineCursor ss(line);
+            ss.skipField(); // type
             
-            vector<Point> points;
-            double lon, lat;
+            points.clear();
+            double lon = 0, lat = 0;
             while (ss >> lon) {
                 ss.ignore(1, ',');
                 ss >> lat;
@@ -50,22 +141,24 @@ public:
             for (size_t i = 0; i + 1 < points.size(); i++) {
                 int n1 = getOrCreateNode(points[i]);
                 int n2 = getOrCreateNode(points[i + 1]);
-                double dist = haversineDistance(points[i], points[i + 1]);
-                addEdge(n1, n2, dist, "road");
+                batch.add(n1, n2, points[i], points[i + 1]);
             }
         }
+        addSegments(batch, "road");
     }
     
     void loadTransitRoute(const string& filename, const string& type) {
         ifstream file(filename);
         string line;
+        vector<Point> stops;
+        scratchArena.reset();
+        SegmentBatch batch(&scratchArena);
         
         while (getline(file, line)) {
-            stringstream ss(line);
-            string transportType;
-            getline(ss, transportType, ',');
+            LineCursor ss(line);
+            ss.skipField(); // transport type
             
-            vector<Point> stops;
+            stops.clear();
             double lon, lat;
             
             while (ss.peek() != EOF) {
@@ -84,10 +177,10 @@ public:
             for (size_t i = 0; i + 1 < stops.size(); i++) {
                 int n1 = getOrCreateNode(stops[i]);
                 int n2 = getOrCreateNode(stops[i + 1]);
-                double dist = haversineDistance(stops[i], stops[i + 1]);
-                addEdge(n1, n2, dist, type);
+                batch.add(n1, n2, stops[i], stops[i + 1]);
             }
         }
+        addSegments(batch, type);
     }
     
     void loadAllData() {
@@ -95,19 +188,41 @@ public:
         loadTransitRoute("Datasets/Routemap-DhakaMetroRail.csv", "metro");
         loadTransitRoute("Datasets/Routemap-BikolpoBus.csv", "bikolpo");
         loadTransitRoute("Datasets/Routemap-UttaraBus.csv", "uttara");
+        scratchArena.release();
     }
     
     int findNearestNode(const Point& p) {
-        int nearest = -1;
-        double minDist = INF;
-        for (size_t i = 0; i < nodes.size(); i++) {
-            double dist = haversineDistance(p, nodes[i].location);
-            if (dist < minDist) {
-                minDist = dist;
-                nearest = i;
-            }
+        return nearestPoint(p, nodes.size(), [this](size_t i) { return nodes[i].location; });
+    }
+    
+    // Frees the coordinate -> node lookup and the loading scratch space.
+    // Only needed while loading, so call this after the last load*() call.
+    void releaseLookup() {
+        pointToNode.clear();
+        lookupArena.release();
+        scratchArena.release();
+    }
+    
+    // Heap footprint: node records and lookup entries, and
+    // the edge arena (which includes slack left behind by edge list growth).
+    size_t nodeBytes() const {
+        size_t bytes = nodes.capacity() * sizeof(Node) + lookupArena.reservedBytes();
+        for (const Node& n : nodes) bytes += n.name.capacity() > 15 ? n.name.capacity() + 1 : 0;
+        return bytes;
+    }
+    
+    size_t edgeBytes() const {
+        size_t bytes = edgeArena.reservedBytes();
+        for (const Node& n : nodes) {
+            for (const Edge& e : n.edges) bytes += e.type.capacity() > 15 ? e.type.capacity() + 1 : 0;
         }
-        return nearest;
+        return bytes;
+    }
+    
+    void printAllocationStats() const {
+        edgeArena.printStats("edge arena");
+        lookupArena.printStats("lookup arena");
+        scratchArena.printStats("load scratch arena");
     }
     
     const vector<Node>& getNodes() const { return nodes; }
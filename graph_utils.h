@@ -13,6 +13,7 @@
 #include <iomanip>
 #include <limits>
 #include <string>
+#include "arena.h"
 
 using namespace std;
 
@@ -33,10 +34,15 @@ struct Edge {
     Edge(int to, double dist, string type) : to(to), distance(dist), type(type) {}
 };
 
+typedef ArenaVector<Edge> EdgeList;
+typedef ArenaVector<int> PathVector; // solver results, valid until the solver's next query; copies are heap-backed
+
 struct Node {
     Point location;
-    vector<Edge> edges;
+    EdgeList edges;
     string name;
+    Node() {}
+    Node(const Point& location, Arena* edgeArena) : location(location), edges(edgeArena) {}
 };
 
 struct TimeInfo {
@@ -83,8 +89,7 @@ double haversineDistance(const Point& p1, const Point& p2) {
     return EARTH_RADIUS * c;
 }
 
-void generateKML(const vector<Point>& points, const string& filename) {
-    ofstream kml(filename);
+void writeKMLHeader(ofstream& kml, const string& filename) {
     kml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
     kml << "<kml xmlns=\"http://earth.google.com/kml/2.1\">\n";
     kml << "<Document>\n";
@@ -93,11 +98,9 @@ void generateKML(const vector<Point>& points, const string& filename) {
     kml << "<LineString>\n";
     kml << "<tessellate>1</tessellate>\n";
     kml << "<coordinates>\n";
-    
-    for (const Point& p : points) {
-        kml << p.lon << "," << p.lat << ",0\n";
-    }
-    
+}
+
+void writeKMLFooter(ofstream& kml) {
     kml << "</coordinates>\n";
     kml << "</LineString>\n";
     kml << "</Placemark>\n";
@@ -105,6 +108,26 @@ void generateKML(const vector<Point>& points, const string& filename) {
     kml << "</kml>\n";
 }
 
+void generateKML(const vector<Point>& points, const string& filename) {
+    ofstream kml(filename);
+    writeKMLHeader(kml, filename);
+    for (const Point& p : points) {
+        kml << p.lon << "," << p.lat << ",0\n";
+    }
+    writeKMLFooter(kml);
+}
+
+// Writes a path of node indices directly, without copying the points out.
+template <class Path>
+void generateKML(const vector<Node>& nodes, const Path& path, const string& filename) {
+    ofstream kml(filename);
+    writeKMLHeader(kml, filename);
+    for (int idx : path) {
+        kml << nodes[idx].location.lon << "," << nodes[idx].location.lat << ",0\n";
+    }
+    writeKMLFooter(kml);
+}
+
 string getModeDescription(const string& type) {
     if (type == "road") return "Car";
     if (type == "metro") return "Metro";
@@ -113,4 +136,11 @@ string getModeDescription(const string& type) {
     return type;
 }
 
+bool hasFlag(int argc, char* argv[], const string& flag) {
+    for (int i = 1; i < argc; i++) {
+        if (flag == argv[i]) return true;
+    }
+    return false;
+}
+
 #endif // GRAPH_UTILS_H
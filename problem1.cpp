@@ -16,16 +16,21 @@ class Problem1Solver
 {
 private:
     GraphLoader &graph;
+    Arena queryArena; // scratch and result of the current solve()
 
 public:
     Problem1Solver(GraphLoader &g) : graph(g) {}
 
-    pair<vector<int>, double> solve(int start, int end)
+    // The returned path lives in queryArena and the next solve() overwrites
+    // it; a copy (PathVector keep = result.first) is heap-backed and stays valid
+    pair<PathVector, double> solve(int start, int end)
     {
+        queryArena.reset();
         const vector<Node> &nodes = graph.getNodes();
-        vector<double> dist(nodes.size(), INF);
-        vector<int> parent(nodes.size(), -1);
-        priority_queue<State, vector<State>, greater<State>> pq;
+        ArenaVector<double> dist(nodes.size(), INF, &queryArena);
+        ArenaVector<int> parent(nodes.size(), -1, &queryArena);
+        ArenaVector<State> heap(&queryArena);
+        priority_queue<State, ArenaVector<State>, greater<State>> pq(greater<State>(), move(heap));
 
         dist[start] = 0;
         pq.push(State(start, 0));
@@ -56,7 +61,7 @@ public:
             }
         }
 
-        vector<int> path;
+        PathVector path(&queryArena);
         if (dist[end] < INF)
         {
             int curr = end;
@@ -68,7 +73,12 @@ public:
             reverse(path.begin(), path.end());
         }
 
-        return {path, dist[end]};
+        return {move(path), dist[end]};
+    }
+
+    void printAllocationStats() const
+    {
+        queryArena.printStats("query arena");
     }
 
     void printSolution(const Point &source, const Point &dest)
@@ -80,8 +90,9 @@ public:
         int startNode = graph.findNearestNode(source);
         int endNode = graph.findNearestNode(dest);
 
-        pair<vector<int>, double> result = solve(startNode, endNode);
-        vector<int> path = result.first;
+        // path is only valid until this solver runs solve() again
+        pair<PathVector, double> result = solve(startNode, endNode);
+        const PathVector &path = result.first;
         double totalDist = result.second;
 
         if (path.empty())
@@ -95,12 +106,7 @@ public:
         cout << "Path with " << path.size() << " nodes" << endl;
 
         // Generate KML
-        vector<Point> points;
-        for (int idx : path)
-        {
-            points.push_back(nodes[idx].location);
-        }
-        generateKML(points, "problem1_route.kml");
+        generateKML(nodes, path, "problem1_route.kml");
         cout << "KML file generated: problem1_route.kml" << endl;
 
         // Print route description
@@ -123,13 +129,18 @@ public:
     }
 };
 
-int main()
+int main(int argc, char *argv[])
 {
+    bool showStats = hasFlag(argc, argv, "--stats");
+
     cout << "Problem 1: Shortest Car Route" << endl;
     cout << "Loading data..." << endl;
 
+    size_t heapAtStart = heapAllocationCount();
     GraphLoader graph;
     graph.loadAllData();
+    graph.releaseLookup();
+    size_t heapAfterLoad = heapAllocationCount();
     cout << "Loaded " << graph.getNodeCount() << " nodes" << endl;
 
     Problem1Solver solver(graph);
@@ -145,5 +156,13 @@ int main()
 
     solver.printSolution(source, dest);
 
+    if (showStats)
+    {
+        cout << "\nAllocation Stats:" << endl;
+        graph.printAllocationStats();
+        solver.printAllocationStats();
+        printHeapStats(heapAfterLoad - heapAtStart, heapAllocationCount() - heapAfterLoad);
+    }
+
     return 0;
 }
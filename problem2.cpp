@@ -16,6 +16,7 @@ class Problem2Solver
 {
 private:
     GraphLoader &graph;
+    Arena queryArena; // scratch and result of the current solve()
     map<string, double> costPerKm;
 
 public:
@@ -25,12 +26,16 @@ public:
         costPerKm["metro"] = 5.0;
     }
 
-    pair<vector<int>, double> solve(int start, int end)
+    // The returned path lives in queryArena and the next solve() overwrites
+    // it; a copy (PathVector keep = result.first) is heap-backed and stays valid
+    pair<PathVector, double> solve(int start, int end)
     {
+        queryArena.reset();
         const vector<Node> &nodes = graph.getNodes();
-        vector<double> dist(nodes.size(), INF);
-        vector<int> parent(nodes.size(), -1);
-        priority_queue<State, vector<State>, greater<State>> pq;
+        ArenaVector<double> dist(nodes.size(), INF, &queryArena);
+        ArenaVector<int> parent(nodes.size(), -1, &queryArena);
+        ArenaVector<State> heap(&queryArena);
+        priority_queue<State, ArenaVector<State>, greater<State>> pq(greater<State>(), move(heap));
 
         dist[start] = 0;
         pq.push(State(start, 0));
@@ -62,7 +67,7 @@ public:
             }
         }
 
-        vector<int> path;
+        PathVector path(&queryArena);
         if (dist[end] < INF)
         {
             int curr = end;
@@ -74,7 +79,12 @@ public:
             reverse(path.begin(), path.end());
         }
 
-        return {path, dist[end]};
+        return {move(path), dist[end]};
+    }
+
+    void printAllocationStats() const
+    {
+        queryArena.printStats("query arena");
     }
 
     void printSolution(const Point &source, const Point &dest)
@@ -86,8 +96,9 @@ public:
         int startNode = graph.findNearestNode(source);
         int endNode = graph.findNearestNode(dest);
 
-        pair<vector<int>, double> result = solve(startNode, endNode);
-        vector<int> path = result.first;
+        // path is only valid until this solver runs solve() again
+        pair<PathVector, double> result = solve(startNode, endNode);
+        const PathVector &path = result.first;
         double totalCost = result.second;
 
         if (path.empty())
@@ -100,12 +111,7 @@ public:
         cout << "Total Cost: " << fixed << setprecision(2) << totalCost << endl;
 
         // Generate KML
-        vector<Point> points;
-        for (int idx : path)
-        {
-            points.push_back(nodes[idx].location);
-        }
-        generateKML(points, "problem2_route.kml");
+        generateKML(nodes, path, "problem2_route.kml");
         cout << "KML file generated: problem2_route.kml" << endl;
 
         // Print detailed route
@@ -149,13 +155,18 @@ public:
     }
 };
 
-int main()
+int main(int argc, char *argv[])
 {
+    bool showStats = hasFlag(argc, argv, "--stats");
+
     cout << "Problem 2: Cheapest Route (Car + Metro)" << endl;
     cout << "Loading data..." << endl;
 
+    size_t heapAtStart = heapAllocationCount();
     GraphLoader graph;
     graph.loadAllData();
+    graph.releaseLookup();
+    size_t heapAfterLoad = heapAllocationCount();
     cout << "Loaded " << graph.getNodeCount() << " nodes" << endl;
 
     Problem2Solver solver(graph);
@@ -171,5 +182,13 @@ int main()
 
     solver.printSolution(source, dest);
 
+    if (showStats)
+    {
+        cout << "\nAllocation Stats:" << endl;
+        graph.printAllocationStats();
+        solver.printAllocationStats();
+        printHeapStats(heapAfterLoad - heapAtStart, heapAllocationCount() - heapAfterLoad);
+    }
+
     return 0;
 }
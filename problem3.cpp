@@ -1,5 +1,7 @@
 // Problem 3: Cheapest Route with Car, Metro, and All Buses
-#include "graph_loader.h"
+#include "alternative_routes.h"
+#include "compact_graph.h"
+#include <memory>
 
 struct State
 {
@@ -12,27 +14,39 @@ struct State
     }
 };
 
+map<string, double> problem3CostTable()
+{
+    map<string, double> costPerKm;
+    costPerKm["road"] = 20.0;
+    costPerKm["metro"] = 5.0;
+    costPerKm["bikolpo"] = 7.0;
+    costPerKm["uttara"] = 7.0;
+    return costPerKm;
+}
+
 class Problem3Solver
 {
 private:
     GraphLoader &graph;
+    Arena queryArena; // scratch and result of the current solve()
     map<string, double> costPerKm;
+    AlternativeRouteFinder finder; // kept across queries so its arenas are reused
 
 public:
-    Problem3Solver(GraphLoader &g) : graph(g)
+    Problem3Solver(GraphLoader &g) : graph(g), costPerKm(problem3CostTable()), finder(g, costPerKm)
     {
-        costPerKm["road"] = 20.0;
-        costPerKm["metro"] = 5.0;
-        costPerKm["bikolpo"] = 7.0;
-        costPerKm["uttara"] = 7.0;
     }
 
-    pair<vector<int>, double> solve(int start, int end)
+    // The returned path lives in queryArena and the next solve() overwrites
+    // it; a copy (PathVector keep = result.first) is heap-backed and stays valid
+    pair<PathVector, double> solve(int start, int end)
     {
+        queryArena.reset();
         const vector<Node> &nodes = graph.getNodes();
-        vector<double> dist(nodes.size(), INF);
-        vector<int> parent(nodes.size(), -1);
-        priority_queue<State, vector<State>, greater<State>> pq;
+        ArenaVector<double> dist(nodes.size(), INF, &queryArena);
+        ArenaVector<int> parent(nodes.size(), -1, &queryArena);
+        ArenaVector<State> heap(&queryArena);
+        priority_queue<State, ArenaVector<State>, greater<State>> pq(greater<State>(), move(heap));
 
         dist[start] = 0;
         pq.push(State(start, 0));
@@ -61,7 +75,7 @@ public:
             }
         }
 
-        vector<int> path;
+        PathVector path(&queryArena);
         if (dist[end] < INF)
         {
             int curr = end;
@@ -73,7 +87,13 @@ public:
             reverse(path.begin(), path.end());
         }
 
-        return {path, dist[end]};
+        return {move(path), dist[end]};
+    }
+
+    void printAllocationStats() const
+    {
+        queryArena.printStats("query arena");
+        finder.printAllocationStats();
     }
 
     void printSolution(const Point &source, const Point &dest)
@@ -85,8 +105,9 @@ public:
         int startNode = graph.findNearestNode(source);
         int endNode = graph.findNearestNode(dest);
 
+        // path is only valid until this solver runs solve() again
         auto result = solve(startNode, endNode);
-        vector<int> path = result.first;
+        const PathVector &path = result.first;
         double totalCost = result.second;
 
         if (path.empty())
@@ -99,12 +120,7 @@ public:
         cout << "Total Cost: " << fixed << setprecision(2) << totalCost << endl;
 
         // Generate KML
-        vector<Point> points;
-        for (int idx : path)
-        {
-            points.push_back(nodes[idx].location);
-        }
-        generateKML(points, "problem3_route.kml");
+        generateKML(nodes, path, "problem3_route.kml");
         cout << "KML file generated: problem3_route.kml" << endl;
 
         // Print detailed route
@@ -145,19 +161,138 @@ public:
             cout << "  " << getModeDescription(currentMode) << ": "
                  << segmentDist << " km, Cost: " << segmentCost << endl;
         }
+
+        // Alternative routes for resilience
+        vector<RouteOption> options = finder.findFromCheapest(path);
+
+        cout << "\nAlternative Routes:" << endl;
+        for (size_t i = 0; i < options.size(); i++)
+        {
+            string kmlName = "problem3_alt" + to_string(i + 1) + ".kml";
+            generateKML(nodes, options[i].path, kmlName);
+
+            cout << "  " << (i + 1) << ". " << options[i].label << ": "
+                 << options[i].distance << " km, Cost: " << options[i].cost
+                 << " [" << kmlName << "]" << endl;
+        }
+    }
+
+    // Re-solves the query on the compact graph and reports the difference
+    void compareCompact(const CompactGraph &compact, const Point &source, const Point &dest)
+    {
+        double rates[MODE_COUNT];
+        ratesFromCostTable(costPerKm, rates);
+
+        int startNode = compact.findNearestNode(source);
+        int endNode = compact.findNearestNode(dest);
+        // full.first is only valid until this solver runs solve() again
+        auto full = solve(graph.findNearestNode(source), graph.findNearestNode(dest));
+        auto result = compact.solve(startNode, endNode, rates);
+
+        cout << "\nCompact Graph Check:" << endl;
+        cout << "  Cost: " << fixed << setprecision(6) << result.cost
+             << " (full: " << full.second << ", relative diff: " << scientific
+             << fabs(result.cost - full.second) / max(full.second, 1e-12) << ")" << endl;
+        cout << "  Same path: " << (equal(result.path.begin(), result.path.end(), full.first.begin(), full.first.end()) ? "yes" : "no") << endl;
+        cout.unsetf(ios::floatfield);
     }
 };
 
-int main()
+// Answers a query from the compact graph alone (--compact). The detailed
+// route uses the mode of each edge taken; alternative routes need the full
+// graph and are not offered.
+void printCompactSolution(const CompactGraph &compact, const Point &source, const Point &dest)
 {
+    cout << "\nProblem 3: Cheapest Route (Car + Metro + Buses, compact graph)" << endl;
+    cout << "Source: (" << source.lon << ", " << source.lat << ")" << endl;
+    cout << "Destination: (" << dest.lon << ", " << dest.lat << ")" << endl;
+
+    map<string, double> costPerKm = problem3CostTable();
+    double rates[MODE_COUNT];
+    ratesFromCostTable(costPerKm, rates);
+
+    int startNode = compact.findNearestNode(source);
+    int endNode = compact.findNearestNode(dest);
+    CompactRoute route = compact.solve(startNode, endNode, rates);
+
+    if (route.path.empty())
+    {
+        cout << "No route found!" << endl;
+        return;
+    }
+
+    cout << "Total Cost: " << fixed << setprecision(2) << route.cost << endl;
+
+    vector<Point> points;
+    for (int idx : route.path)
+    {
+        points.push_back(compact.location(idx));
+    }
+    generateKML(points, "problem3_route.kml");
+    cout << "KML file generated: problem3_route.kml" << endl;
+
+    // Print detailed route
+    cout << "\nDetailed Route:" << endl;
+    string currentMode = "";
+    double segmentDist = 0;
+    double segmentCost = 0;
+
+    for (size_t i = 0; i < route.modes.size(); i++)
+    {
+        string edgeType = MODE_TYPES[route.modes[i]];
+
+        if (currentMode != edgeType && i > 0)
+        {
+            cout << "  " << getModeDescription(currentMode) << ": "
+                 << segmentDist << " km, Cost: " << segmentCost << endl;
+            segmentDist = 0;
+            segmentCost = 0;
+        }
+
+        currentMode = edgeType;
+        segmentDist += route.distances[i];
+        segmentCost += route.distances[i] * costPerKm[edgeType];
+    }
+
+    if (segmentDist > 0)
+    {
+        cout << "  " << getModeDescription(currentMode) << ": "
+             << segmentDist << " km, Cost: " << segmentCost << endl;
+    }
+
+    cout << "\nAlternative Routes: not available in compact mode (needs the full graph)" << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+int main(int argc, char *argv[])
+{
+    bool showStats = hasFlag(argc, argv, "--stats");
+    // --compact: low-memory mode, the query is answered from CompactGraph and
+    // the full graph is freed once the compact one is built. --check keeps
+    // the full graph as well and compares the two answers.
+    bool compactMode = hasFlag(argc, argv, "--compact");
+    bool checkCompact = compactMode && hasFlag(argc, argv, "--check");
+
     cout << "Problem 3: Cheapest Route (All Modes)" << endl;
     cout << "Loading data..." << endl;
 
-    GraphLoader graph;
-    graph.loadAllData();
-    cout << "Loaded " << graph.getNodeCount() << " nodes" << endl;
+    size_t heapAtStart = heapAllocationCount();
+    unique_ptr<GraphLoader> graph = make_unique<GraphLoader>();
+    graph->loadAllData();
+    graph->releaseLookup();
+    cout << "Loaded " << graph->getNodeCount() << " nodes" << endl;
 
-    Problem3Solver solver(graph);
+    unique_ptr<CompactGraph> compact;
+    if (compactMode)
+    {
+        compact = make_unique<CompactGraph>(*graph);
+        compact->printMemoryReport(*graph);
+        if (!checkCompact)
+        {
+            graph.reset();
+        }
+    }
+    size_t heapAfterLoad = heapAllocationCount();
 
     double srcLon, srcLat, dstLon, dstLat;
     cout << "\nEnter source coordinates (longitude latitude): ";
@@ -168,7 +303,32 @@ int main()
     Point source(srcLon, srcLat);
     Point dest(dstLon, dstLat);
 
-    solver.printSolution(source, dest);
+    unique_ptr<Problem3Solver> solver;
+    if (compact)
+    {
+        printCompactSolution(*compact, source, dest);
+        if (graph)
+        {
+            solver = make_unique<Problem3Solver>(*graph);
+            solver->compareCompact(*compact, source, dest);
+        }
+    }
+    else
+    {
+        solver = make_unique<Problem3Solver>(*graph);
+        solver->printSolution(source, dest);
+    }
+
+    if (showStats)
+    {
+        cout << "\nAllocation Stats:" << endl;
+        if (graph)
+        {
+            graph->printAllocationStats();
+            solver->printAllocationStats();
+        }
+        printHeapStats(heapAfterLoad - heapAtStart, heapAllocationCount() - heapAfterLoad);
+    }
 
     return 0;
 }